@@ -6,11 +6,13 @@ int main(int count, char** argvect)
 {
     // Expected arguments: <learning_rate> <num_epochs> <batch_size> <hidden_size>
     // <train_images_path> <train_labels_path> <test_images_path> <test_labels_path> <prediction_log_file_path>
-    if (count != 10) {
+    // followed by optional <key>=<value> options
+    if (count < 10) {
         std::cerr << "Usage:\n  " << argvect[0]
                   << " <learning_rate> <num_epochs> <batch_size> <hidden_size>"
                   << " <train_images_path> <train_labels_path>"
-                  << " <test_images_path> <test_labels_path> <prediction_log_file_path>\n";
+                  << " <test_images_path> <test_labels_path> <prediction_log_file_path>"
+                  << " [augment_seed=<seed>] [precision=fp64|bf16] [prune_sparsity=<fraction>]\n";
         return 1;
     }
 
@@ -28,6 +30,37 @@ int main(int count, char** argvect)
         return 1;
     }
 
+    // Parse optional <key>=<value> options
+    bool augment = false;
+    unsigned int augment_seed = 0;
+    std::string precision = "fp64";
+    double prune_sparsity = 0.0;
+    for (int i = 10; i < count; ++i) {
+        const std::string option = argvect[i];
+        const size_t separator = option.find('=');
+        const std::string key = option.substr(0, separator);
+        const std::string value = separator == std::string::npos ? "" : option.substr(separator + 1);
+        try {
+            if (key == "augment_seed") {
+                augment = true;
+                augment_seed = static_cast<unsigned int>(std::stoul(value));
+            } else if (key == "precision" && (value == "fp64" || value == "bf16")) {
+                precision = value;
+            } else if (key == "prune_sparsity") {
+                prune_sparsity = std::stod(value);
+                if (prune_sparsity < 0.0 || prune_sparsity >= 1.0)
+                    throw std::out_of_range("sparsity must be in [0, 1)");
+            } else {
+                std::cerr << "Error: Unknown option: " << option << std::endl;
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Invalid value for option: " << option << "\n"
+                      << "Caught exception: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // Parse file paths
     std::string train_images_path        = argvect[5];
     std::string train_labels_path        = argvect[6];
@@ -45,13 +78,25 @@ int main(int count, char** argvect)
               << "Train labels path   : " << train_labels_path   << "\n"
               << "Test images path    : " << test_images_path    << "\n"
               << "Test labels path    : " << test_labels_path    << "\n"
-              << "Prediction log file : " << prediction_log_file_path << "\n\n";
+              << "Prediction log file : " << prediction_log_file_path << "\n";
+    if (augment)
+        std::cout << "Augmentation seed   : " << augment_seed << "\n";
+    std::cout << "Precision           : " << precision << "\n";
+    if (prune_sparsity > 0.0)
+        std::cout << "Pruned sparsity     : " << prune_sparsity << "\n";
+    std::cout << "\n";
 
     // Neural network created
     NeuralNetwork NN( learning_rate, num_epochs, batch_size, hidden_size,
         train_images_path, train_labels_path,
         test_images_path, test_labels_path,
         prediction_log_file_path);
+    if (augment)
+        NN.enableAugmentation(augment_seed);
+    if (precision == "bf16")
+        NN.enableBF16();
+    if (prune_sparsity > 0.0)
+        NN.enablePruning(prune_sparsity);
 
     // Time ttaken training phase
     auto start_time = std::chrono::high_resolution_clock::now();
@@ -62,6 +107,10 @@ int main(int count, char** argvect)
     std::chrono::duration<double> elapsed_seconds = end_time - start_time;
     std::cout << "Training completed in " << elapsed_seconds.count() << " seconds.\n";
 
+    // Sparse weights for inference
+    if (prune_sparsity > 0.0)
+        NN.finalizePruning();
+
     // Test phase
     std::cout << "\nNow running test phase...\n";
     NN.test();
@@ -0,0 +1,92 @@
+#include <string>
+#include <iomanip>
+#include "NeuralNetwork.hpp"
+#include <chrono>
+
+// Best-of-N wall time of one inference pass over the test set, together with its accuracy
+static std::pair<double, double> timeInference(NeuralNetwork &NN, readImageMNIST &images,
+                                               readLabelMNIST &labels, int repeats)
+{
+    double best_seconds = 0.0, accuracy = 0.0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start_time = std::chrono::steady_clock::now();
+        accuracy = NN.evaluate(images, labels);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+        if (r == 0 || elapsed.count() < best_seconds)
+            best_seconds = elapsed.count();
+    }
+    return {best_seconds, accuracy};
+}
+
+int main(int count, char** argvect)
+{
+    // Expected arguments: <learning_rate> <num_epochs> <batch_size> <hidden_size>
+    // <train_images_path> <train_labels_path> <test_images_path> <test_labels_path> <finetune_epochs>
+    if (count != 10) {
+        std::cerr << "Usage:\n  " << argvect[0]
+                  << " <learning_rate> <num_epochs> <batch_size> <hidden_size>"
+                  << " <train_images_path> <train_labels_path>"
+                  << " <test_images_path> <test_labels_path> <finetune_epochs>\n";
+        return 1;
+    }
+
+    double learning_rate;
+    int num_epochs, batch_size, hidden_size, finetune_epochs;
+    try {
+        learning_rate = std::stod(argvect[1]);
+        num_epochs    = std::stoi(argvect[2]);
+        batch_size    = std::stoi(argvect[3]);
+        hidden_size   = std::stoi(argvect[4]);
+        finetune_epochs = std::stoi(argvect[9]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid numeric argument.\n"
+                  << "Caught exception: " << e.what() << std::endl;
+        return 1;
+    }
+    const std::string train_images_path = argvect[5];
+    const std::string train_labels_path = argvect[6];
+    const std::string test_images_path  = argvect[7];
+    const std::string test_labels_path  = argvect[8];
+    constexpr int repeats = 5;
+    // 0 is the dense reference, fine-tuned for the same number of epochs as the pruned rows
+    const double sparsities[] = {0.0, 0.5, 0.8, 0.9, 0.95};
+
+    readImageMNIST test_data_obj(batch_size);
+    test_data_obj.readImageData(test_images_path);
+    readLabelMNIST test_labels_obj(batch_size);
+    test_labels_obj.readLabelData(test_labels_path);
+
+    // Dense baseline
+    NeuralNetwork baseline(learning_rate, num_epochs, batch_size, hidden_size,
+        train_images_path, train_labels_path, test_images_path, test_labels_path, "");
+    baseline.train();
+
+    // Fine-tune a copy of the baseline for every row, pruning it gradually unless the row is
+    // the dense reference, then run the sparse kernel on the pruned ones
+    struct Result { double sparsity; size_t non_zeros, bytes; double accuracy, seconds; };
+    std::vector<Result> results;
+    for (double sparsity : sparsities) {
+        NeuralNetwork tuned = baseline;
+        tuned.setNumEpochs(finetune_epochs);
+        if (sparsity > 0.0)
+            tuned.enablePruning(sparsity);
+        tuned.train();
+        if (sparsity > 0.0)
+            tuned.finalizePruning();
+        auto [seconds, accuracy] = timeInference(tuned, test_data_obj, test_labels_obj, repeats);
+        results.push_back({sparsity, tuned.getNumNonZeros(), tuned.getModelBytes(), accuracy, seconds});
+    }
+    const double dense_seconds = results.front().seconds;
+
+    std::cout << "\n" << std::setw(10) << "Sparsity" << std::setw(12) << "Non-zeros"
+              << std::setw(14) << "Model [KiB]" << std::setw(14) << "Accuracy [%]"
+              << std::setw(16) << "Inference [ms]" << std::setw(10) << "Speedup" << "\n"
+              << std::fixed << std::setprecision(2);
+    for (const Result &r : results) {
+        std::cout << std::setw(10) << r.sparsity << std::setw(12) << r.non_zeros
+                  << std::setw(14) << static_cast<double>(r.bytes) / 1024.0
+                  << std::setw(14) << r.accuracy << std::setw(16) << r.seconds * 1e3
+                  << std::setw(10) << dense_seconds / r.seconds << "\n";
+    }
+    return 0;
+}
@@ -23,4 +23,6 @@ do
 done < "$1"
 
 # Run the build/mnist executable with the appropriate arguments
-./build/NeuralNetworkMNIST $learning_rate $num_epochs $batch_size $hidden_size $rel_path_train_images $rel_path_train_labels $rel_path_test_images $rel_path_test_labels $rel_path_log_file
\ No newline at end of file
+./build/NeuralNetworkMNIST $learning_rate $num_epochs $batch_size $hidden_size $rel_path_train_images $rel_path_train_labels $rel_path_test_images $rel_path_test_labels $rel_path_log_file \
+    ${augment_seed:+augment_seed=$augment_seed} ${precision:+precision=$precision} \
+    ${prune_sparsity:+prune_sparsity=$prune_sparsity}
\ No newline at end of file
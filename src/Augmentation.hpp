@@ -0,0 +1,143 @@
+#pragma once
+/* ---- On-the-fly Data Augmentation ---- */
+#include <Eigen/Dense>
+#include <random>
+#include <cmath>
+
+// Applies a random affine warp (sub-pixel shift, rotation, scale, shear), a smooth elastic
+// distortion and additive noise to every image of a batch. The transform of each image only
+// depends on (seed, epoch, batch index), so results do not depend on which thread runs it.
+class DataAugmentation {
+private:
+    static constexpr int elastic_grid = 4;  // Control points per axis of the elastic field
+    static constexpr long pad = 2;          // Zero border so every bilinear tap is in range
+    size_t rows, cols, image_size;
+    long padded_rows, padded_cols;
+    unsigned int seed;
+
+    double max_shift = 1.5;        // Pixels
+    double max_rotation = 0.1745;  // Radians (~10 degrees)
+    double max_scale = 0.1;        // Relative
+    double max_shear = 0.1;
+    double elastic_alpha = 1.0;    // Pixels, displacement of the elastic control points
+    double noise_stddev = 0.02;
+
+    // Output pixel coordinates relative to the image centre, shared by every image
+    Eigen::VectorXd grid_x, grid_y;
+    // Bilinear upsampling from the elastic control grid to all pixels (image_size x grid^2)
+    Eigen::MatrixXd elastic_upsample;
+
+public:
+    DataAugmentation(size_t number_of_rows, size_t number_of_columns, unsigned int augment_seed);
+    ~DataAugmentation() = default;
+    // Returns an augmented copy of the batch (batch_size x rows*cols)
+    Eigen::MatrixXd apply(const Eigen::MatrixXd &batch, size_t epoch, size_t batch_index) const;
+};
+
+inline DataAugmentation::DataAugmentation(size_t number_of_rows, size_t number_of_columns,
+                                          unsigned int augment_seed)
+    : rows(number_of_rows), cols(number_of_columns),
+      image_size(number_of_rows * number_of_columns),
+      padded_rows(static_cast<long>(number_of_rows) + 2 * pad),
+      padded_cols(static_cast<long>(number_of_columns) + 2 * pad), seed(augment_seed) {
+    grid_x.resize(image_size);
+    grid_y.resize(image_size);
+    elastic_upsample = Eigen::MatrixXd::Zero(image_size, elastic_grid * elastic_grid);
+    const double centre_x = 0.5 * static_cast<double>(cols - 1);
+    const double centre_y = 0.5 * static_cast<double>(rows - 1);
+
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            const size_t p = r * cols + c;
+            grid_x(p) = static_cast<double>(c) - centre_x;
+            grid_y(p) = static_cast<double>(r) - centre_y;
+            // Position of the pixel in control grid units
+            double u = cols > 1 ? static_cast<double>(c) / (cols - 1) * (elastic_grid - 1) : 0.0;
+            double v = rows > 1 ? static_cast<double>(r) / (rows - 1) * (elastic_grid - 1) : 0.0;
+            int u0 = std::min(static_cast<int>(u), elastic_grid - 2);
+            int v0 = std::min(static_cast<int>(v), elastic_grid - 2);
+            double fu = u - u0, fv = v - v0;
+            elastic_upsample(p, v0 * elastic_grid + u0) = (1.0 - fu) * (1.0 - fv);
+            elastic_upsample(p, v0 * elastic_grid + u0 + 1) = fu * (1.0 - fv);
+            elastic_upsample(p, (v0 + 1) * elastic_grid + u0) = (1.0 - fu) * fv;
+            elastic_upsample(p, (v0 + 1) * elastic_grid + u0 + 1) = fu * fv;
+        }
+    }
+}
+
+inline Eigen::MatrixXd DataAugmentation::apply(const Eigen::MatrixXd &batch, size_t epoch,
+                                               size_t batch_index) const {
+    const Eigen::Index batch_size = batch.rows();
+    std::seed_seq seq{seed, static_cast<unsigned int>(epoch), static_cast<unsigned int>(batch_index)};
+    std::mt19937 rng(seq);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+
+    // Draw per-image transform parameters
+    Eigen::VectorXd a00(batch_size), a01(batch_size), a10(batch_size), a11(batch_size),
+        shift_x(batch_size), shift_y(batch_size);
+    for (Eigen::Index b = 0; b < batch_size; ++b) {
+        const double angle = max_rotation * unit(rng);
+        const double scale = 1.0 + max_scale * unit(rng);
+        const double shear = max_shear * unit(rng);
+        // Inverse mapping: rotation * [scale, shear; 0, scale]
+        a00(b) = std::cos(angle) * scale;
+        a01(b) = std::cos(angle) * shear - std::sin(angle) * scale;
+        a10(b) = std::sin(angle) * scale;
+        a11(b) = std::sin(angle) * shear + std::cos(angle) * scale;
+        shift_x(b) = 0.5 * static_cast<double>(cols - 1) + max_shift * unit(rng);
+        shift_y(b) = 0.5 * static_cast<double>(rows - 1) + max_shift * unit(rng);
+    }
+    const Eigen::MatrixXd control_x = elastic_alpha *
+        Eigen::MatrixXd::NullaryExpr(elastic_grid * elastic_grid, batch_size, [&]() { return gauss(rng); });
+    const Eigen::MatrixXd control_y = elastic_alpha *
+        Eigen::MatrixXd::NullaryExpr(elastic_grid * elastic_grid, batch_size, [&]() { return gauss(rng); });
+
+    // Source coordinates for all pixels of all images at once: (image_size x batch_size)
+    Eigen::MatrixXd source_x = grid_x * a00.transpose() + grid_y * a01.transpose()
+                               + elastic_upsample * control_x;
+    Eigen::MatrixXd source_y = grid_x * a10.transpose() + grid_y * a11.transpose()
+                               + elastic_upsample * control_y;
+    source_x.rowwise() += shift_x.transpose();
+    source_y.rowwise() += shift_y.transpose();
+
+    // Zero-padded copy of the batch, one image per column (padded_rows * padded_cols x batch_size)
+    Eigen::MatrixXd padded = Eigen::MatrixXd::Zero(padded_rows * padded_cols, batch_size);
+    for (Eigen::Index b = 0; b < batch_size; ++b) {
+        for (size_t r = 0; r < rows; ++r) {
+            padded.col(b).segment((r + pad) * padded_cols + pad, cols) =
+                batch.row(b).segment(r * cols, cols).transpose();
+        }
+    }
+
+    // Clamping into the border keeps far-away coordinates on zero pixels, so no bounds checks
+    const Eigen::Index count = source_x.size();
+    const Eigen::ArrayXd x = Eigen::Map<const Eigen::ArrayXd>(source_x.data(), count)
+                                 .max(-1.0).min(static_cast<double>(cols));
+    const Eigen::ArrayXd y = Eigen::Map<const Eigen::ArrayXd>(source_y.data(), count)
+                                 .max(-1.0).min(static_cast<double>(rows));
+    const Eigen::ArrayXd x0 = x.floor(), y0 = y.floor();
+    const Eigen::ArrayXd fx = x - x0, fy = y - y0;
+    // Flat index of the top-left tap; column b of the padded batch starts at b * padded_size
+    const Eigen::Index padded_size = padded.rows();
+    const Eigen::Array<Eigen::Index, Eigen::Dynamic, 1> image_offset =
+        Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>::LinSpaced(count, 0, count - 1)
+            / image_size * padded_size;
+    const Eigen::Array<Eigen::Index, Eigen::Dynamic, 1> top_left = image_offset +
+        ((y0 + pad) * padded_cols + (x0 + pad)).cast<Eigen::Index>();
+    const Eigen::Array<Eigen::Index, Eigen::Dynamic, 1> bottom_left = top_left + padded_cols;
+
+    // Gather the four taps for all pixels of all images, then blend them
+    const Eigen::Map<const Eigen::ArrayXd> pixels(padded.data(), padded.size());
+    const Eigen::ArrayXd v00 = pixels(top_left), v01 = pixels(top_left + 1);
+    const Eigen::ArrayXd v10 = pixels(bottom_left), v11 = pixels(bottom_left + 1);
+    const Eigen::ArrayXd blended = (1.0 - fy) * ((1.0 - fx) * v00 + fx * v01) +
+                                   fy * ((1.0 - fx) * v10 + fx * v11);
+    Eigen::MatrixXd augmented =
+        Eigen::Map<const Eigen::MatrixXd>(blended.data(), image_size, batch_size).transpose();
+
+    // Additive Gaussian noise, clamped back to the normalized pixel range
+    augmented += noise_stddev *
+        Eigen::MatrixXd::NullaryExpr(batch_size, image_size, [&]() { return gauss(rng); });
+    return augmented.cwiseMax(0.0).cwiseMin(1.0);
+}
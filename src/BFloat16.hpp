@@ -0,0 +1,173 @@
+#pragma once
+/* ---- bfloat16 Storage and GEMM ---- */
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BF16_HAS_AVX512_KERNEL 1
+#endif
+
+// Row-major so every row is contiguous in memory
+using MatrixBF16 = Eigen::Matrix<Eigen::bfloat16, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using RowMatrixXf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Packs a (k x n) weight matrix as bf16 pairs along k: row q holds (w(2q, j), w(2q+1, j)) at
+// columns 2j and 2j+1, zero-padded when k is odd. This is the operand layout of dpbf16
+inline MatrixBF16 packBF16Pairs(const Eigen::MatrixXf &w) {
+    const Eigen::Index k = w.rows(), n = w.cols(), pairs = (k + 1) / 2;
+    MatrixBF16 packed(pairs, 2 * n);
+    for (Eigen::Index j = 0; j < n; ++j) {
+        for (Eigen::Index q = 0; q < pairs; ++q) {
+            packed(q, 2 * j) = Eigen::bfloat16(w(2 * q, j));
+            packed(q, 2 * j + 1) = Eigen::bfloat16(2 * q + 1 < k ? w(2 * q + 1, j) : 0.0f);
+        }
+    }
+    return packed;
+}
+
+// bf16 is the upper half of an fp32, so widening is a 16-bit shift the compiler vectorizes
+inline void widenBF16(const Eigen::bfloat16 *src, float *dst, Eigen::Index count) {
+    const auto *bits = reinterpret_cast<const uint16_t*>(src);
+    for (Eigen::Index i = 0; i < count; ++i) {
+        const uint32_t word = static_cast<uint32_t>(bits[i]) << 16;
+        std::memcpy(dst + i, &word, sizeof(float));
+    }
+}
+
+// Portable path: widens the packed weights one block of pairs at a time, so they are still read
+// from memory as bf16 and only an L2-sized fp32 block exists at once
+inline RowMatrixXf gemmBF16Generic(const MatrixBF16 &a, const MatrixBF16 &b_packed) {
+    constexpr Eigen::Index block_pairs = 32;
+    const Eigen::Index m = a.rows(), k = a.cols(), pairs = b_packed.rows(), n = b_packed.cols() / 2;
+    // 2 * pairs columns, so an odd k lines up with the zero pad of the weights
+    RowMatrixXf a_f = RowMatrixXf::Zero(m, 2 * pairs);
+    for (Eigen::Index i = 0; i < m; ++i)
+        widenBF16(a.data() + i * k, a_f.data() + i * 2 * pairs, k);
+
+    RowMatrixXf result = RowMatrixXf::Zero(m, n);
+    RowMatrixXf b_block(2 * block_pairs, n);
+    Eigen::RowVectorXf packed_row(2 * n);
+    for (Eigen::Index q = 0; q < pairs; q += block_pairs) {
+        const Eigen::Index block = std::min(block_pairs, pairs - q);
+        for (Eigen::Index p = 0; p < block; ++p) {
+            widenBF16(b_packed.data() + (q + p) * 2 * n, packed_row.data(), 2 * n);
+            // Even entries belong to weight row 2(q+p), odd ones to row 2(q+p)+1
+            b_block.row(2 * p) = Eigen::Map<const Eigen::RowVectorXf, 0, Eigen::InnerStride<2>>(
+                packed_row.data(), n);
+            b_block.row(2 * p + 1) = Eigen::Map<const Eigen::RowVectorXf, 0, Eigen::InnerStride<2>>(
+                packed_row.data() + 1, n);
+        }
+        result.noalias() += a_f.middleCols(2 * q, 2 * block) * b_block.topRows(2 * block);
+    }
+    return result;
+}
+
+#if defined(BF16_HAS_AVX512_KERNEL)
+// Register tile of MR rows of a against NR vectors of 16 output columns, over pairs [q_begin, q_end).
+// Each weight vector loaded is reused for MR rows and each broadcast pair of a for NR vectors;
+// last_cols (1..16) is the width of the last vector
+template <int MR, int NR>
+__attribute__((target("avx512f,avx512bw,avx512bf16")))
+inline void gemmBF16TileAvx512(const uint16_t *a, Eigen::Index k, const uint16_t *b, Eigen::Index ldb,
+                               Eigen::Index q_begin, Eigen::Index q_end, float *c, Eigen::Index ldc,
+                               int last_cols, bool accumulate) {
+    const __mmask16 store_mask = static_cast<__mmask16>((1u << last_cols) - 1u);
+    const __mmask32 load_mask = static_cast<__mmask32>((uint64_t{1} << (2 * last_cols)) - 1u);
+    __m512 acc[MR][NR];
+    for (int r = 0; r < MR; ++r) {
+        for (int s = 0; s < NR; ++s) {
+            const __mmask16 mask = s == NR - 1 ? store_mask : static_cast<__mmask16>(0xFFFF);
+            acc[r][s] = accumulate ? _mm512_maskz_loadu_ps(mask, c + r * ldc + 16 * s) : _mm512_setzero_ps();
+        }
+    }
+
+    for (Eigen::Index q = q_begin; q < q_end; ++q) {
+        __m512bh vb[NR];
+        for (int s = 0; s < NR; ++s) {
+            const uint16_t *b_row = b + q * ldb + 32 * s;
+            vb[s] = s == NR - 1 ? (__m512bh)_mm512_maskz_loadu_epi16(load_mask, b_row)
+                                : (__m512bh)_mm512_loadu_si512(b_row);
+        }
+        // The last pair of an odd k only has its low half in a; the weights pad the high half
+        const bool full_pair = 2 * q + 1 < k;
+        for (int r = 0; r < MR; ++r) {
+            uint32_t pair = a[r * k + 2 * q];
+            if (full_pair)
+                std::memcpy(&pair, a + r * k + 2 * q, sizeof(pair));
+            const __m512bh va = (__m512bh)_mm512_set1_epi32(static_cast<int>(pair));
+            for (int s = 0; s < NR; ++s)
+                acc[r][s] = _mm512_dpbf16_ps(acc[r][s], va, vb[s]);
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        for (int s = 0; s < NR; ++s) {
+            const __mmask16 mask = s == NR - 1 ? store_mask : static_cast<__mmask16>(0xFFFF);
+            _mm512_mask_storeu_ps(c + r * ldc + 16 * s, mask, acc[r][s]);
+        }
+    }
+}
+
+// Dispatches a strip of up to 64 columns to the tile with the matching number of vectors
+template <int MR>
+__attribute__((target("avx512f,avx512bw,avx512bf16")))
+inline void gemmBF16StripAvx512(const uint16_t *a, Eigen::Index k, const uint16_t *b, Eigen::Index ldb,
+                                Eigen::Index q_begin, Eigen::Index q_end, float *c, Eigen::Index ldc,
+                                Eigen::Index cols, bool accumulate) {
+    const int vectors = static_cast<int>((cols + 15) / 16);
+    const int last_cols = static_cast<int>(cols - 16 * (vectors - 1));
+    switch (vectors) {
+        case 4: gemmBF16TileAvx512<MR, 4>(a, k, b, ldb, q_begin, q_end, c, ldc, last_cols, accumulate); break;
+        case 3: gemmBF16TileAvx512<MR, 3>(a, k, b, ldb, q_begin, q_end, c, ldc, last_cols, accumulate); break;
+        case 2: gemmBF16TileAvx512<MR, 2>(a, k, b, ldb, q_begin, q_end, c, ldc, last_cols, accumulate); break;
+        default: gemmBF16TileAvx512<MR, 1>(a, k, b, ldb, q_begin, q_end, c, ldc, last_cols, accumulate); break;
+    }
+}
+
+// AVX-512-BF16 path: 4 x 64 register tiles. A 64-column panel of block_pairs weight pairs (32 KiB)
+// stays in L1 while every row tile of a streams past it
+__attribute__((target("avx512f,avx512bw,avx512bf16")))
+inline RowMatrixXf gemmBF16Avx512(const MatrixBF16 &a, const MatrixBF16 &b_packed) {
+    constexpr Eigen::Index mr = 4, nc = 64, block_pairs = 128;
+    const Eigen::Index m = a.rows(), k = a.cols(), pairs = b_packed.rows(), n = b_packed.cols() / 2;
+    RowMatrixXf result = RowMatrixXf::Zero(m, n);
+    const auto *a_data = reinterpret_cast<const uint16_t*>(a.data());
+    const auto *b_data = reinterpret_cast<const uint16_t*>(b_packed.data());
+    const Eigen::Index ldb = 2 * n;
+
+    for (Eigen::Index j = 0; j < n; j += nc) {
+        const Eigen::Index cols = std::min(nc, n - j);
+        for (Eigen::Index q = 0; q < pairs; q += block_pairs) {
+            const Eigen::Index q_end = std::min(pairs, q + block_pairs);
+            const bool accumulate = q > 0;
+            Eigen::Index i = 0;
+            // A single-vector strip (e.g. the output layer) needs more rows to hide the dpbf16 latency
+            if (cols <= 16) {
+                for (; i + 2 * mr <= m; i += 2 * mr)
+                    gemmBF16TileAvx512<2 * mr, 1>(a_data + i * k, k, b_data + 2 * j, ldb, q, q_end,
+                                                  result.data() + i * n + j, n, static_cast<int>(cols), accumulate);
+            }
+            for (; i + mr <= m; i += mr)
+                gemmBF16StripAvx512<mr>(a_data + i * k, k, b_data + 2 * j, ldb, q, q_end,
+                                        result.data() + i * n + j, n, cols, accumulate);
+            for (; i < m; ++i)
+                gemmBF16StripAvx512<1>(a_data + i * k, k, b_data + 2 * j, ldb, q, q_end,
+                                       result.data() + i * n + j, n, cols, accumulate);
+        }
+    }
+    return result;
+}
+#endif
+
+// Computes a * w with fp32 accumulation, where a is (m x k) and b_packed = packBF16Pairs(w) for a
+// (k x n) w; result is (m x n). The AVX-512-BF16 kernel is selected at runtime on CPUs that support it
+inline RowMatrixXf gemmBF16(const MatrixBF16 &a, const MatrixBF16 &b_packed) {
+#if defined(BF16_HAS_AVX512_KERNEL)
+    static const bool has_avx512_bf16 = __builtin_cpu_supports("avx512bf16");
+    if (has_avx512_bf16)
+        return gemmBF16Avx512(a, b_packed);
+#endif
+    return gemmBF16Generic(a, b_packed);
+}
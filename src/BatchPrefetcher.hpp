@@ -0,0 +1,85 @@
+#pragma once
+/* ---- Batch Prefetcher ---- */
+#include <Eigen/Dense>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// One long-lived worker thread with a one-slot queue: submit() hands over the job for the next
+// batch, take() blocks until its result is ready. Only one job may be outstanding at a time.
+// An exception thrown by the job is rethrown from take() on the calling thread.
+class BatchPrefetcher {
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::function<Eigen::MatrixXd()> job;
+    Eigen::MatrixXd result;
+    std::exception_ptr error;
+    bool has_result = false, stop = false;
+    std::thread worker;
+
+    void run();
+
+public:
+    BatchPrefetcher() : worker(&BatchPrefetcher::run, this) {}
+    ~BatchPrefetcher();
+    BatchPrefetcher(const BatchPrefetcher &) = delete;
+    BatchPrefetcher &operator=(const BatchPrefetcher &) = delete;
+
+    void submit(std::function<Eigen::MatrixXd()> next_job);
+    Eigen::MatrixXd take();
+};
+
+inline BatchPrefetcher::~BatchPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+inline void BatchPrefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return stop || job; });
+        if (stop)
+            return;
+        auto current_job = std::move(job);
+        job = nullptr;
+        // Run the job without holding the lock so submit()/take() are not blocked on it
+        lock.unlock();
+        Eigen::MatrixXd current_result;
+        std::exception_ptr current_error;
+        try {
+            current_result = current_job();
+        } catch (...) {
+            current_error = std::current_exception();
+        }
+        lock.lock();
+        result = std::move(current_result);
+        error = current_error;
+        has_result = true;
+        cv.notify_all();
+    }
+}
+
+inline void BatchPrefetcher::submit(std::function<Eigen::MatrixXd()> next_job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = std::move(next_job);
+    }
+    cv.notify_all();
+}
+
+inline Eigen::MatrixXd BatchPrefetcher::take() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return has_result; });
+    has_result = false;
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+    return std::move(result);
+}
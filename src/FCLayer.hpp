@@ -1,13 +1,29 @@
 #pragma once
 /* ---- Fully Connected Layer ---- */
 #include "Eigen/Dense"
+#include "Eigen/Sparse"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
 #include "SGD.hpp"
+#include "BFloat16.hpp"
 
 extern Eigen::MatrixXd XavierUniformInit(int rows, int cols, unsigned int seed);
 class FullyConnected {
 private:
     Eigen::MatrixXd weights, input_tensor;
     size_t input_size{}, output_size{};
+    // bfloat16 mode: fp32 master weights for the update, pair-packed bf16 copy for the forward GEMM
+    bool use_bf16 = false;
+    Eigen::MatrixXf master_weights;
+    MatrixBF16 weights_bf16_packed, input_tensor_bf16;
+    // Magnitude pruning: 0/1 mask of kept weights (bias row always kept), sparse copy for inference.
+    // uint8_t rather than bool so that applying it is a vectorized multiply, not a select
+    Eigen::Array<uint8_t, Eigen::Dynamic, Eigen::Dynamic> mask;
+    bool use_sparse = false;
+    Eigen::SparseMatrix<double> sparse_weights;  // Column-major, i.e. CSR of W^T
+    Eigen::RowVectorXd bias;
 
 public:
     FullyConnected() = default;
@@ -20,12 +36,139 @@ public:
     ~FullyConnected() = default;
 
     void setWeights(const Eigen::MatrixXd &weights_matrix) {
-        weights = weights_matrix;
+        if (use_bf16) {
+            master_weights = weights_matrix.cast<float>();
+            weights_bf16_packed = packBF16Pairs(master_weights);
+        } else {
+            weights = weights_matrix;
+        }
+    }
+
+    // Switching to bfloat16 storage; the double weights and cache are released
+    void enableBF16() {
+        use_bf16 = true;
+        master_weights = weights.cast<float>();
+        weights_bf16_packed = packBF16Pairs(master_weights);
+        weights.resize(0, 0);
+        input_tensor.resize(0, 0);
+    }
+
+    // Current weights in double, independent of the storage mode
+    Eigen::MatrixXd getWeights() const {
+        if (use_sparse)
+            throw std::logic_error("FullyConnected::getWeights: dense weights were released by enableSparse");
+        return use_bf16 ? Eigen::MatrixXd(master_weights.cast<double>()) : weights;
+    }
+
+    // Zeroing the given fraction of non-bias weights with the smallest magnitude; the mask keeps
+    // them at zero in backward. Already pruned weights have magnitude 0 and stay pruned
+    void prune(double fraction) {
+        if (use_sparse)
+            throw std::logic_error("FullyConnected::prune: sparse layers are inference only");
+        Eigen::MatrixXd current = getWeights();
+        const Eigen::Index count = current.topRows(input_size).size();
+        const auto num_pruned = static_cast<Eigen::Index>(fraction * static_cast<double>(count));
+        mask.setOnes(input_size + 1, output_size);
+        if (num_pruned > 0) {
+            std::vector<double> magnitudes(count);
+            Eigen::Map<Eigen::MatrixXd>(magnitudes.data(), input_size, output_size) =
+                current.topRows(input_size).cwiseAbs();
+            std::nth_element(magnitudes.begin(), magnitudes.begin() + (num_pruned - 1), magnitudes.end());
+            const double threshold = magnitudes[num_pruned - 1];
+            mask.topRows(input_size) = (current.topRows(input_size).array().abs() > threshold).cast<uint8_t>();
+        }
+        setWeights((current.array() * mask.cast<double>()).matrix());
+    }
+
+    // Switching to the sparse inference kernel; dense weights are released, so no more backward
+    void enableSparse() {
+        if (use_sparse)
+            return;
+        const Eigen::MatrixXd current = getWeights();
+        sparse_weights = current.topRows(input_size).sparseView();
+        sparse_weights.makeCompressed();
+        bias = current.row(input_size);
+        use_sparse = true;
+        weights.resize(0, 0);
+        master_weights.resize(0, 0);
+        weights_bf16_packed.resize(0, 0);
+        input_tensor.resize(0, 0);
+        input_tensor_bf16.resize(0, 0);
+        mask.resize(0, 0);
+    }
+
+    // Number of weights excluding the bias row
+    size_t getNumWeights() const {
+        return input_size * output_size;
+    }
+
+    size_t getNumNonZeros() const {
+        return use_sparse ? static_cast<size_t>(sparse_weights.nonZeros())
+                          : static_cast<size_t>((getWeights().topRows(input_size).array() != 0.0).count());
+    }
+
+    // Bytes needed to store the parameters in the current format. Every format stores the
+    // bias as one value per output, counted separately from the (input_size x output_size) weights
+    size_t getWeightBytes() const {
+        if (use_sparse) {
+            const size_t index_bytes = sparse_weights.nonZeros() * sizeof(int) +
+                                       (sparse_weights.outerSize() + 1) * sizeof(int);
+            return sparse_weights.nonZeros() * sizeof(double) + index_bytes + output_size * sizeof(double);
+        }
+        const size_t value_bytes = use_bf16 ? sizeof(float) + sizeof(Eigen::bfloat16) : sizeof(double);
+        return input_size * output_size * value_bytes + output_size * value_bytes;
+    }
+
+    // Inference-only forward pass: same result as forward(), but nothing is cached for backward,
+    // so every storage format (dense, bf16, sparse) only pays for its own kernel
+    Eigen::MatrixXd infer(const Eigen::MatrixXd &input) const {
+        const size_t batch_size = input.rows();
+        if (use_sparse) {
+            // Sparse x dense: every stored weight adds one scaled input column to its output
+            // column. Rows are processed in blocks so the partial sums stay in registers
+            constexpr Eigen::Index block = 32;
+            Eigen::MatrixXd output(batch_size, output_size);
+            const Eigen::Index full_rows = static_cast<Eigen::Index>(batch_size) / block * block;
+            for (Eigen::Index r = 0; r < full_rows; r += block) {
+                for (Eigen::Index j = 0; j < sparse_weights.outerSize(); ++j) {
+                    Eigen::Matrix<double, block, 1> acc = Eigen::Matrix<double, block, 1>::Constant(bias(j));
+                    for (Eigen::SparseMatrix<double>::InnerIterator it(sparse_weights, j); it; ++it)
+                        acc += it.value() * input.col(it.index()).segment<block>(r);
+                    output.col(j).segment<block>(r) = acc;
+                }
+            }
+            const Eigen::Index tail_rows = static_cast<Eigen::Index>(batch_size) - full_rows;
+            for (Eigen::Index j = 0; tail_rows > 0 && j < sparse_weights.outerSize(); ++j) {
+                output.col(j).tail(tail_rows).setConstant(bias(j));
+                for (Eigen::SparseMatrix<double>::InnerIterator it(sparse_weights, j); it; ++it)
+                    output.col(j).tail(tail_rows) += it.value() * input.col(it.index()).tail(tail_rows);
+            }
+            return output;
+        }
+        if (use_bf16) {
+            MatrixBF16 input_bf16(batch_size, input_size + 1);
+            input_bf16.leftCols(input_size) = input.cast<Eigen::bfloat16>();
+            input_bf16.col(input_size).setConstant(Eigen::bfloat16(1.0f));
+            return gemmBF16(input_bf16, weights_bf16_packed).cast<double>();
+        }
+        Eigen::MatrixXd output = input * weights.topRows(input_size);
+        output.rowwise() += weights.row(input_size);
+        return output;
     }
 
     // Augmenting input with bias column, computing linear combination using weights
     Eigen::MatrixXd forward(const Eigen::MatrixXd &input) {
         const size_t batch_size = input.rows();
+        // Sparse layers are inference only, so there is nothing to cache
+        if (use_sparse)
+            return infer(input);
+        if (use_bf16) {
+            input_tensor_bf16.resize(batch_size, input_size + 1);
+            input_tensor_bf16.leftCols(input_size) = input.cast<Eigen::bfloat16>();
+            input_tensor_bf16.col(input_size).setConstant(Eigen::bfloat16(1.0f));
+            // bf16 operands, fp32 accumulation
+            return gemmBF16(input_tensor_bf16, weights_bf16_packed).cast<double>();
+        }
         // Augment input with column of ones for the bias
         input_tensor.resize(batch_size, input_size + 1);
         input_tensor.block(0, 0, batch_size, input_size) = input;
@@ -36,8 +179,25 @@ public:
 
     // Computing gradient w.r.t. weights, updates weights, returns gradient for previous layer
     Eigen::MatrixXd backward(const Eigen::MatrixXd &grad_output, SGD &sgd) {
+        if (use_sparse)
+            throw std::logic_error("FullyConnected::backward: sparse layers are inference only");
+        if (use_bf16) {
+            const Eigen::MatrixXf grad_output_f = grad_output.cast<float>();
+            Eigen::MatrixXf grad_weights = input_tensor_bf16.cast<float>().transpose() * grad_output_f;
+            // Pruned weights receive no update
+            if (mask.size() > 0)
+                grad_weights.array() *= mask.cast<float>();
+            Eigen::MatrixXf grad_input = grad_output_f * master_weights.topRows(input_size).transpose();
+            // Update the fp32 master copy, then refresh the bf16 working copy
+            master_weights = sgd.update_weights(master_weights, grad_weights);
+            weights_bf16_packed = packBF16Pairs(master_weights);
+            return grad_input.cast<double>();
+        }
         // Compute dW = X^T * dY, shape: [ (input_size+1) x output_size ]
         Eigen::MatrixXd grad_weights = input_tensor.transpose() * grad_output;
+        // Pruned weights receive no update
+        if (mask.size() > 0)
+            grad_weights.array() *= mask.cast<double>();
         //   dX = dY * W^T, but ignoring the last row of W (the bias row).
         Eigen::MatrixXd grad_input = grad_output * weights.topRows(input_size).transpose();
         // Update weights in place with the computed gradient
@@ -4,23 +4,32 @@
 /* ---- Cross Entropy Loss ---- */
 #include <Eigen/Dense>
 #include <cmath>
+#include "BFloat16.hpp"
 
 constexpr double EPS = 1e-10; // To avoid log(0) issues
 
 class CrossEntropyLoss {
 private:
     Eigen::MatrixXd prediction_cache; // Store prediction for backward pass
+    bool use_bf16 = false;
+    MatrixBF16 prediction_cache_bf16; // Same cache in bfloat16 mode
 
 public:
     CrossEntropyLoss() = default;
     ~CrossEntropyLoss() = default;
+    // Caching the predictions as bfloat16 instead of double
+    void enableBF16() { use_bf16 = true; prediction_cache.resize(0, 0); }
     double forward(const Eigen::MatrixXd &predictions, const Eigen::MatrixXd &labels);
     Eigen::MatrixXd backward(const Eigen::MatrixXd &labels);
 };
 
 // Cross Entropy Forward Pass: Computes the loss
 inline double CrossEntropyLoss::forward(const Eigen::MatrixXd &predictions, const Eigen::MatrixXd &labels) {
-    prediction_cache = predictions; // Save predictions for backward pass
+    // Save predictions for backward pass
+    if (use_bf16)
+        prediction_cache_bf16 = predictions.cast<Eigen::bfloat16>();
+    else
+        prediction_cache = predictions;
     // Compute element-wise cross-entropy loss
     Eigen::MatrixXd log_preds = (predictions.array() + EPS).log();
     double loss = -(labels.array() * log_preds.array()).sum();
@@ -31,6 +40,8 @@ inline double CrossEntropyLoss::forward(const Eigen::MatrixXd &predictions, cons
 // Cross Entropy Backward Pass: Computes gradient for backpropagation
 inline Eigen::MatrixXd CrossEntropyLoss::backward(const Eigen::MatrixXd &labels) {
     // Compute gradient: dL/dp = (p - y) / batch_size
+    if (use_bf16)
+        return (prediction_cache_bf16.cast<double>() - labels) / labels.rows();
     return (prediction_cache - labels) / labels.rows();
 }
 
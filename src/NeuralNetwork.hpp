@@ -6,11 +6,16 @@
 #include <algorithm>
 #include <random>
 #include <chrono>
+#include <memory>
+#include <optional>
+#include <initializer_list>
 #include "Loss.hpp"
 #include "SGD.hpp"
 #include "ReLU.hpp"
 #include "Softmax.hpp"
 #include "FCLayer.hpp"
+#include "Augmentation.hpp"
+#include "BatchPrefetcher.hpp"
 #include "readImageMNIST.hpp"
 #include "readLabelMNIST.hpp"
 // Very important. Stay focused. All the best for the exam.
@@ -29,6 +34,16 @@ private:
     CrossEntropyLoss ce_loss;
     SGD sgd;
 
+    // On-the-fly augmentation of training batches
+    bool augment = false;
+    unsigned int augment_seed = 0;
+
+    // bfloat16 storage of weights, cached activations and image batches
+    bool use_bf16 = false;
+
+    // Target fraction of pruned weights, reached gradually over the training epochs
+    double prune_sparsity = 0.0;
+
     // File paths
     std::string train_data_path, train_labels_path,
     test_data_path, test_labels_path, prediction_log_file_path;
@@ -50,6 +65,50 @@ public:
     }
     ~NeuralNetwork() = default;
 
+    // Augmenting every training batch with a transform that is deterministic per seed
+    void enableAugmentation(unsigned int seed) {
+        augment = true;
+        augment_seed = seed;
+    }
+
+    // Storing weights, activations and images as bfloat16 with fp32 accumulation
+    void enableBF16() {
+        use_bf16 = true;
+        fc1.enableBF16();
+        fc2.enableBF16();
+        relu.enableBF16();
+        softmax.enableBF16();
+        ce_loss.enableBF16();
+    }
+
+    void setNumEpochs(int epochs) {
+        num_epochs = epochs;
+    }
+
+    // Iterative magnitude pruning of both layers during training
+    void enablePruning(double sparsity) {
+        prune_sparsity = sparsity;
+    }
+
+    // Switching both layers to the sparse kernel. A layer below the target (single epoch, or
+    // training stopped at the time limit) is pruned to it first; otherwise this is a no-op
+    void finalizePruning() {
+        for (FullyConnected *layer : {&fc1, &fc2}) {
+            const auto target = static_cast<size_t>(prune_sparsity * static_cast<double>(layer->getNumWeights()));
+            if (layer->getNumWeights() - layer->getNumNonZeros() < target)
+                layer->prune(prune_sparsity);
+            layer->enableSparse();
+        }
+    }
+
+    size_t getModelBytes() const {
+        return fc1.getWeightBytes() + fc2.getWeightBytes();
+    }
+
+    size_t getNumNonZeros() const {
+        return fc1.getNumNonZeros() + fc2.getNumNonZeros();
+    }
+
     // Forward pass through FC1 -> ReLU -> FC2 -> Softmax.
     Eigen::MatrixXd forward(const Eigen::MatrixXd &input_tensor)
     {
@@ -60,6 +119,14 @@ public:
         return out_softmax;
     }
 
+    // Inference pass FC1 -> ReLU -> FC2 without caching anything for backward. Returns the
+    // scores before softmax, which is monotonic, so the row-wise argmax is the prediction
+    Eigen::MatrixXd infer(const Eigen::MatrixXd &input_tensor) const
+    {
+        Eigen::MatrixXd out_relu = fc1.infer(input_tensor).cwiseMax(0.0);
+        return fc2.infer(out_relu);
+    }
+
     // Backward pass: Propagate the loss gradient through FC2, ReLU, then FC1.
     Eigen::MatrixXd backward(const Eigen::MatrixXd &deriv_loss)
     {
@@ -76,10 +143,23 @@ public:
         const double time_limit_seconds = 1200.0; // Limit of 20 mins for CI
         // Load MNIST data
         readImageMNIST train_data_obj(batch_size);
+        train_data_obj.setStorageBF16(use_bf16);
         train_data_obj.readImageData(train_data_path);
         readLabelMNIST train_labels_obj(batch_size);
         train_labels_obj.readLabelData(train_labels_path);
         size_t num_batches = train_data_obj.getNumOfBatches();
+        // Fraction the layers were last pruned to, and the growth that triggers the next prune
+        double pruned_fraction = 0.0;
+        constexpr double prune_step = 0.01;
+        // Image geometry read from the IDX header drives the augmentation; a single worker
+        // thread augments the next batch while the current one is trained on
+        std::optional<DataAugmentation> augmentation;
+        std::unique_ptr<BatchPrefetcher> prefetcher;
+        if (augment) {
+            augmentation.emplace(train_data_obj.getNumOfRows(), train_data_obj.getNumOfColumns(),
+                                 augment_seed);
+            prefetcher = std::make_unique<BatchPrefetcher>();
+        }
 
         for (int epoch = 0; epoch < num_epochs; ++epoch)
         {
@@ -90,11 +170,41 @@ public:
             std::shuffle(batch_indices.begin(), batch_indices.end(),
                          std::default_random_engine(static_cast<unsigned>(epoch)));
 
+            // Raise the pruned fraction linearly from the start of the second epoch, so the
+            // first one trains the dense network and the last one trains at the target.
+            // A single epoch stays dense; finalizePruning() then prunes once after it.
+            // Layers are only re-pruned once the target has grown by prune_step
+            if (prune_sparsity > 0.0 && epoch > 0)
+            {
+                const double target = prune_sparsity * epoch / (num_epochs - 1);
+                if (target - pruned_fraction >= prune_step || epoch == num_epochs - 1)
+                {
+                    fc1.prune(target);
+                    fc2.prune(target);
+                    pruned_fraction = target;
+                }
+            }
+
+            auto augmentBatch = [&augmentation, &train_data_obj, epoch](size_t b) {
+                return [&augmentation, &train_data_obj, epoch, b]() {
+                    return augmentation->apply(train_data_obj.getBatch(b), epoch, b);
+                };
+            };
+            if (augment && num_batches > 0)
+                prefetcher->submit(augmentBatch(batch_indices[0]));
+
             for (size_t idx = 0; idx < num_batches; ++idx)
             {
                 size_t b = batch_indices[idx];
+                Eigen::MatrixXd batch_images;
+                if (augment) {
+                    batch_images = prefetcher->take();
+                    if (idx + 1 < num_batches)
+                        prefetcher->submit(augmentBatch(batch_indices[idx + 1]));
+                } else {
+                    batch_images = train_data_obj.getBatch(b);
+                }
                 // Forward pass
-                Eigen::MatrixXd batch_images = train_data_obj.getBatch(b);
                 Eigen::MatrixXd batch_labels = train_labels_obj.getBatch(b);
                 Eigen::MatrixXd predictions = forward(batch_images);
                 // Compute cross-entropy loss for debug NN
@@ -122,6 +232,7 @@ public:
     void test()
     {
         readImageMNIST test_data_obj(batch_size);
+        test_data_obj.setStorageBF16(use_bf16);
         test_data_obj.readImageData(test_data_path);
         readLabelMNIST test_labels_obj(batch_size);
         test_labels_obj.readLabelData(test_labels_path);
@@ -133,16 +244,25 @@ public:
             return;
         }
 
-        size_t num_test_batches = test_data_obj.getNumOfBatches();
+        double accuracy = evaluate(test_data_obj, test_labels_obj, &prediction_log);
+        prediction_log.close();
+        std::cout << "Test accuracy: " << accuracy << "%" << std::endl;
+    }
+
+    // Accuracy in percent over all batches; predictions are logged if a stream is given
+    double evaluate(readImageMNIST &images, readLabelMNIST &labels, std::ostream *prediction_log = nullptr)
+    {
+        size_t num_test_batches = images.getNumOfBatches();
         int total_samples = 0;
         int correct_predictions = 0;
 
         for (size_t b = 0; b < num_test_batches; ++b)
         {
-            prediction_log << "Current batch: " << b << "\n";
-            Eigen::MatrixXd batch_images = test_data_obj.getBatch(b);
-            Eigen::MatrixXd predictions = forward(batch_images);
-            Eigen::MatrixXd batch_labels = test_labels_obj.getBatch(b);
+            if (prediction_log)
+                *prediction_log << "Current batch: " << b << "\n";
+            Eigen::MatrixXd batch_images = images.getBatch(b);
+            Eigen::MatrixXd predictions = infer(batch_images);
+            Eigen::MatrixXd batch_labels = labels.getBatch(b);
 
             for (int i = 0; i < predictions.rows(); ++i)
             {
@@ -150,18 +270,16 @@ public:
                 predictions.row(i).maxCoeff(&pred_label);
                 Eigen::Index actual_label;
                 batch_labels.row(i).maxCoeff(&actual_label);
-                prediction_log << " - image " << (b * batch_size + i)
-                               << ": Prediction=" << pred_label
-                               << ". Label=" << actual_label << "\n";
+                if (prediction_log)
+                    *prediction_log << " - image " << (b * batch_size + i)
+                                    << ": Prediction=" << pred_label
+                                    << ". Label=" << actual_label << "\n";
                 total_samples++;
                 if (pred_label == actual_label) {
                     correct_predictions++;
                 }
             }
         }
-
-        prediction_log.close();
-        double accuracy = 100.0 * static_cast<double>(correct_predictions) / static_cast<double>(total_samples);
-        std::cout << "Test accuracy: " << accuracy << "%" << std::endl;
+        return 100.0 * static_cast<double>(correct_predictions) / static_cast<double>(total_samples);
     }
 };
\ No newline at end of file
@@ -2,14 +2,19 @@
 #define RELU_HPP
 /* ---- ReLU Activation Function ---- */
 #include <Eigen/Dense>
+#include "BFloat16.hpp"
 
 class ReLU {
 private:
     Eigen::MatrixXd input_cache;  // Stores input for use in backward pass
+    bool use_bf16 = false;
+    MatrixBF16 input_cache_bf16;  // Same cache in bfloat16 mode
 
 public:
     ReLU() = default;
     ~ReLU() = default;
+    // Caching the input as bfloat16 instead of double
+    void enableBF16() { use_bf16 = true; input_cache.resize(0, 0); }
     // Forward pass: applies ReLU activation
     Eigen::MatrixXd forward(const Eigen::MatrixXd& input);
     // Backward pass: computes gradient w.r.t. input
@@ -17,13 +22,20 @@ public:
 };
 
 inline Eigen::MatrixXd ReLU::forward(const Eigen::MatrixXd& input) {
-    input_cache = input;
+    if (use_bf16)
+        input_cache_bf16 = input.cast<Eigen::bfloat16>();
+    else
+        input_cache = input;
     return input.cwiseMax(0.0);  // Element-wise max with 0 (ReLU)
 }
 
 inline Eigen::MatrixXd ReLU::backward(const Eigen::MatrixXd& grad_output) {
     // Gradient mask: 1 where input was > 0, else 0
-    Eigen::MatrixXd relu_derivative = (input_cache.array() > 0.0).cast<double>();
+    Eigen::MatrixXd relu_derivative;
+    if (use_bf16)
+        relu_derivative = (input_cache_bf16.cast<float>().array() > 0.0f).cast<double>();
+    else
+        relu_derivative = (input_cache.array() > 0.0).cast<double>();
     return grad_output.array() * relu_derivative.array();  // Element-wise product
 }
 
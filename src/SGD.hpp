@@ -14,6 +14,7 @@ public:
     ~SGD() = default;
 
     Eigen::MatrixXd update_weights(const Eigen::MatrixXd& weights, const Eigen::MatrixXd& gradients) const;
+    Eigen::MatrixXf update_weights(const Eigen::MatrixXf& weights, const Eigen::MatrixXf& gradients) const;
 };
 
 inline SGD::SGD(double lr) : learning_rate(lr) {}
@@ -23,6 +24,11 @@ inline Eigen::MatrixXd SGD::update_weights(const Eigen::MatrixXd& weights, const
     return weights - learning_rate * gradients;
 }
 
+// Same update on the fp32 master weights used by bfloat16 layers
+inline Eigen::MatrixXf SGD::update_weights(const Eigen::MatrixXf& weights, const Eigen::MatrixXf& gradients) const {
+    return weights - static_cast<float>(learning_rate) * gradients;
+}
+
 
 /* ---- Xavier Uniform Initialization ---- */
 inline Eigen::MatrixXd XavierUniformInit(int rows, int cols, unsigned int seed = 1337) {
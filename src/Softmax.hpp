@@ -1,22 +1,28 @@
 #pragma once
 /* ---- Softmax Activation ---- */
 #include <Eigen/Dense>
+#include "BFloat16.hpp"
 
 class Softmax {
 private:
     Eigen::MatrixXd input_cache;  // Stores input for backward pass
     Eigen::MatrixXd softmax_output;  // Stores softmax output for gradient computation
+    bool use_bf16 = false;
+    MatrixBF16 softmax_output_bf16;  // Same cache in bfloat16 mode
 
 public:
     Softmax() = default;
     ~Softmax() = default;
+    // Caching the output as bfloat16 instead of double
+    void enableBF16() { use_bf16 = true; input_cache.resize(0, 0); softmax_output.resize(0, 0); }
     Eigen::MatrixXd forward(const Eigen::MatrixXd& input_tensor);
     Eigen::MatrixXd backward(const Eigen::MatrixXd& gradient);
 };
 
 inline Eigen::MatrixXd Softmax::forward(const Eigen::MatrixXd& input_tensor) {
-    // Save input for use in backward pass
-    input_cache = input_tensor;
+    // Save input for use in backward pass (not needed in bfloat16 mode)
+    if (!use_bf16)
+        input_cache = input_tensor;
     // Compute max per row (for numerical stability)
     Eigen::VectorXd row_max = input_tensor.rowwise().maxCoeff();
     // Shift input tensor for numerical stability (broadcasting)
@@ -26,17 +32,23 @@ inline Eigen::MatrixXd Softmax::forward(const Eigen::MatrixXd& input_tensor) {
     // Compute row-wise sum of exponentials
     Eigen::VectorXd row_sums = exp_values.rowwise().sum();
     // Compute final softmax output
-    softmax_output = (exp_values.array().colwise() / row_sums.array()).matrix();
-    return softmax_output;
+    Eigen::MatrixXd output = (exp_values.array().colwise() / row_sums.array()).matrix();
+    if (use_bf16)
+        softmax_output_bf16 = output.cast<Eigen::bfloat16>();
+    else
+        softmax_output = output;
+    return output;
 }
 
 inline Eigen::MatrixXd Softmax::backward(const Eigen::MatrixXd& gradient) {
+    const Eigen::MatrixXd output = use_bf16 ? Eigen::MatrixXd(softmax_output_bf16.cast<double>())
+                                            : softmax_output;
     // Compute element-wise product of gradient and softmax output, then sum each row
     Eigen::VectorXd weighted_sum = (gradient.array() *
-        softmax_output.array()).rowwise().sum();
+        output.array()).rowwise().sum();
     // Broadcast sum over all columns and subtract from gradient
     Eigen::MatrixXd adjusted_gradient = gradient.array() -
         weighted_sum.replicate(1, gradient.cols()).array();
     // Multiply by softmax output element-wise to compute gradient
-    return softmax_output.array() * adjusted_gradient.array();
+    return output.array() * adjusted_gradient.array();
 }
\ No newline at end of file
@@ -6,12 +6,15 @@
 #include <algorithm>
 #include <cstring>
 #include <Eigen/Dense>
+#include "BFloat16.hpp"
 
 class readImageMNIST {
 private:
     size_t batch_size_temp, number_of_images_temp,
     number_of_rows_temp, number_of_columns_temp;
     std::vector<Eigen::MatrixXd> batches_temp;
+    bool store_bf16 = false;
+    std::vector<MatrixBF16> batches_bf16;  // Used instead of batches_temp in bfloat16 mode
 
 public:
     explicit readImageMNIST(size_t batch_size);
@@ -20,6 +23,10 @@ public:
     void writeImageToFile(const std::string &output_filepath, size_t index);
     Eigen::MatrixXd getBatch(size_t index);
     size_t getNumOfBatches();
+    // Storing batches as bfloat16; must be set before readImageData
+    void setStorageBF16(bool enable) { store_bf16 = enable; }
+    size_t getNumOfRows() const { return number_of_rows_temp; }
+    size_t getNumOfColumns() const { return number_of_columns_temp; }
 };
 
 inline readImageMNIST::readImageMNIST(size_t batch_size)
@@ -29,11 +36,13 @@ inline readImageMNIST::readImageMNIST(size_t batch_size)
 inline readImageMNIST::~readImageMNIST() {}
 
 inline Eigen::MatrixXd readImageMNIST::getBatch(size_t index) {
+    if (store_bf16)
+        return batches_bf16[index].cast<double>();
     return batches_temp[index];
 }
 
 inline size_t readImageMNIST::getNumOfBatches() {
-    return batches_temp.size();
+    return store_bf16 ? batches_bf16.size() : batches_temp.size();
 }
 
 inline void readImageMNIST::readImageData(const std::string &input_filepath) {
@@ -93,7 +102,10 @@ inline void readImageMNIST::readImageData(const std::string &input_filepath) {
 
         // Store batch and reset when full
         if (batch_filler == batch_size_temp || i == number_of_images_temp - 1) {
-            batches_temp.push_back(image_matrix.topRows(batch_filler));
+            if (store_bf16)
+                batches_bf16.push_back(image_matrix.topRows(batch_filler).cast<Eigen::bfloat16>());
+            else
+                batches_temp.push_back(image_matrix.topRows(batch_filler));
             batch_filler = 0;
         }
     }
@@ -105,7 +117,7 @@ inline void readImageMNIST::writeImageToFile(const std::string &output_filepath,
     size_t row_in_batch = index % batch_size_temp;
 
     // Check if the index is out of range
-    if (batch_no >= batches_temp.size() || row_in_batch >= batches_temp[batch_no].rows()) {
+    if (batch_no >= getNumOfBatches() || row_in_batch >= getBatch(batch_no).rows()) {
         std::cerr << "Error: Image index " << index << " out of range." << std::endl;
         return;
     }
@@ -124,10 +136,11 @@ inline void readImageMNIST::writeImageToFile(const std::string &output_filepath,
            << number_of_columns_temp << "\n";
 
     size_t image_size = number_of_rows_temp * number_of_columns_temp;
+    const Eigen::MatrixXd batch = getBatch(batch_no);
 
     // Write pixel values more efficiently
     for (size_t i = 0; i < image_size; i++) {
-        buffer << batches_temp.at(batch_no)(row_in_batch, i) << "\n";
+        buffer << batch(row_in_batch, i) << "\n";
     }
 
     // Write everything to file in one operation (faster I/O)